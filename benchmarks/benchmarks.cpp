@@ -0,0 +1,224 @@
+/**
+   Copyright 2017 The Cobalt Authors.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.)
+ */
+
+/**
+    Microbenchmarks for the Cobalt hot paths: startup tree construction,
+    flag extraction, command resolution, flag parsing, suggestion
+    generation and usage rendering. Each benchmark reports ns/op and
+    heap allocations per op, measured via a global operator new hook.
+
+    Run with: bazel run //benchmarks:benchmarks
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "../cobalt.hpp"
+
+// ---------------------------------------------------------------------------
+// Allocation counting
+// ---------------------------------------------------------------------------
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// ---------------------------------------------------------------------------
+// Harness
+// ---------------------------------------------------------------------------
+
+template<typename F>
+static void Benchmark(const char* name, size_t iterations, F&& body) {
+    // Warm up once so lazy caches do not dominate the first sample
+    body();
+
+    size_t allocsBefore = g_allocations;
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        body();
+    }
+
+    auto stop = std::chrono::steady_clock::now();
+    size_t allocs = g_allocations - allocsBefore;
+
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+    std::printf("%-32s %12.1f ns/op %10.1f allocs/op\n",
+                name, ns / iterations, (double)allocs / iterations);
+}
+
+// ---------------------------------------------------------------------------
+// Synthetic tree generators
+// ---------------------------------------------------------------------------
+
+// A root with `width` runnable subcommands.
+static Cobalt::detail::Command::PointerType MakeWideTree(int width) {
+    auto root = Cobalt::CreateCommand();
+    root->Use = "bench";
+
+    for (int i = 0; i < width; ++i) {
+        auto cmd = Cobalt::CreateCommand();
+        cmd->Use = "cmd" + std::to_string(i) + " [args]";
+        cmd->Short = "Synthetic command";
+        cmd->Run = [](const Cobalt::ArgumentsView&) { return 0; };
+        root->AddCommand(cmd);
+    }
+
+    return root;
+}
+
+// A chain of `depth` nested commands, leaf runnable.
+static Cobalt::detail::Command::PointerType MakeDeepTree(int depth) {
+    auto root = Cobalt::CreateCommand();
+    root->Use = "bench";
+
+    auto current = root;
+    for (int i = 0; i < depth; ++i) {
+        auto cmd = Cobalt::CreateCommand();
+        cmd->Use = "level" + std::to_string(i);
+        if (i == depth-1) cmd->Run = [](const Cobalt::ArgumentsView&) { return 0; };
+        current->AddCommand(cmd);
+        current = cmd;
+    }
+
+    return root;
+}
+
+// A single runnable command carrying `count` persistent int flags.
+static Cobalt::detail::Command::PointerType MakeFlagHeavyTree(int count, std::vector<int>& storage) {
+    auto root = Cobalt::CreateCommand();
+    root->Use = "bench";
+    root->Run = [](const Cobalt::ArgumentsView&) { return 0; };
+
+    storage.resize(count);
+    for (int i = 0; i < count; ++i) {
+        root->PersistentFlags.Add<int>(storage[i], "flag" + std::to_string(i), "", 0, "Synthetic flag");
+    }
+
+    return root;
+}
+
+// ---------------------------------------------------------------------------
+// Class DSL tree for the construction benchmark
+// ---------------------------------------------------------------------------
+
+class LeafCommand : public Cobalt::Command<LeafCommand> {
+public:
+    static std::string Use() { return "leaf"; }
+    static std::string Short() { return "Synthetic leaf"; }
+    int Run(const Cobalt::ArgumentsView&) { return 0; }
+};
+
+class MidCommand : public Cobalt::Command<MidCommand, LeafCommand, LeafCommand> {
+public:
+    static std::string Use() { return "mid"; }
+};
+
+class BenchRootCommand : public Cobalt::Command<BenchRootCommand, MidCommand, MidCommand, LeafCommand> {
+public:
+    static std::string Use() { return "bench"; }
+};
+
+// ---------------------------------------------------------------------------
+
+int main() {
+    // Startup tree construction
+    Benchmark("construct/inline-wide-100", 100, [] {
+        auto root = MakeWideTree(100);
+        (void)root;
+    });
+
+    Benchmark("construct/class-dsl", 1000, [] {
+        auto root = Cobalt::detail::Convert<BenchRootCommand>()();
+        (void)root;
+    });
+
+    // Flag extraction over a fixed argv corpus
+    Cobalt::Arguments corpus;
+    for (int i = 0; i < 50; ++i) corpus.push_back("positional" + std::to_string(i));
+    for (int i = 0; i < 25; ++i) corpus.push_back("--flag" + std::to_string(i) + "=" + std::to_string(i));
+    Cobalt::ArgumentsView corpusView = corpus;
+
+    Benchmark("extract/ExtractFlags-75", 10000, [&] {
+        Cobalt::FlagValues flags;
+        auto positionals = Cobalt::ExtractFlags(corpusView, flags);
+        (void)positionals;
+    });
+
+    Benchmark("extract/StripFlags-75", 10000, [&] {
+        std::map<std::string, std::string> flags;
+        auto positionals = Cobalt::StripFlags(corpusView, &flags);
+        (void)positionals;
+    });
+
+    // Command resolution
+    auto wide = MakeWideTree(500);
+    wide->Compile();
+    Benchmark("find/wide-500", 100000, [&] {
+        Cobalt::ArgumentsView path = { "cmd250", "arg" };
+        auto cmd = wide->Find(path);
+        (void)cmd;
+    });
+
+    auto deep = MakeDeepTree(10);
+    deep->Compile();
+    Benchmark("find/deep-10", 100000, [&] {
+        Cobalt::ArgumentsView path = { "level0", "level1", "level2", "level3", "level4",
+                                       "level5", "level6", "level7", "level8", "level9" };
+        auto cmd = deep->Find(path);
+        (void)cmd;
+    });
+
+    // Flag parsing
+    std::vector<int> storage;
+    auto flagHeavy = MakeFlagHeavyTree(50, storage);
+    flagHeavy->Compile();
+    Cobalt::FlagValues parsed;
+    for (int i = 0; i < 50; ++i) parsed.push_back({ "--flag" + std::to_string(i), std::to_string(i) });
+
+    Benchmark("parse/50-int-flags", 10000, [&] {
+        flagHeavy->FullFlags().Parse(parsed);
+    });
+
+    // Suggestion generation
+    Benchmark("suggest/wide-500", 10000, [&] {
+        auto suggestions = wide->SuggestionsFor("cmd25x");
+        (void)suggestions;
+    });
+
+    // Usage rendering (cold: invalidate the memoized text each round)
+    Benchmark("usage/wide-500-cold", 1000, [&] {
+        ++wide->MutationGeneration;
+        auto& text = wide->UsageString();
+        (void)text;
+    });
+
+    Benchmark("usage/wide-500-cached", 100000, [&] {
+        auto& text = wide->UsageString();
+        (void)text;
+    });
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+/**
+   Copyright 2017 The Cobalt Authors.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.)
+ */
+
+/**
+    End-to-end latency replay harness. Loads a corpus of recorded argv
+    lines, drives each through Command::Execute against a stubbed tree
+    with no-op Run bodies, and reports p50/p95/p99 dispatch latency plus
+    heap allocations per line as a single machine-readable JSON line,
+    suitable for diffing in CI. The corpus should cover the help,
+    suggestion and error paths alongside happy dispatches, since those
+    carry the worst latencies.
+
+    Run with: bazel run //benchmarks:replay [-- corpus rounds]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../cobalt.hpp"
+
+// ---------------------------------------------------------------------------
+// Allocation counting
+// ---------------------------------------------------------------------------
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// ---------------------------------------------------------------------------
+// Stub tree: realistic shape, no-op bodies
+// ---------------------------------------------------------------------------
+
+static int g_port = 0;
+static std::string g_host;
+static bool g_verbose = false;
+static int g_jobs = 0;
+static bool g_dryRun = false;
+static int g_gracePeriod = 0;
+
+static Cobalt::detail::Command::PointerType MakeStubTree() {
+    auto noop = [](const Cobalt::ArgumentsView&) { return 0; };
+
+    auto root = Cobalt::CreateCommand();
+    root->Use = "replay";
+
+    auto serve = Cobalt::CreateCommand();
+    serve->Use = "serve";
+    serve->Short = "Serve requests";
+    serve->LocalFlags.Add<int>(g_port, "port", "", 8080, "The port");
+    serve->LocalFlags.Add<std::string>(g_host, "host", "", "0.0.0.0", "The host");
+    serve->LocalFlags.Add<bool>(g_verbose, "verbose", "v", false, "Verbose output");
+    serve->Run = noop;
+    root->AddCommand(serve);
+
+    auto build = Cobalt::CreateCommand();
+    build->Use = "build [targets]";
+    build->Short = "Build targets";
+    build->LocalFlags.Add<int>(g_jobs, "jobs", "j", 1, "Parallel jobs");
+    build->Run = noop;
+    root->AddCommand(build);
+
+    auto deploy = Cobalt::CreateCommand();
+    deploy->Use = "deploy [environment]";
+    deploy->Short = "Deploy to an environment";
+    deploy->LocalFlags.Add<bool>(g_dryRun, "dry-run", "", false, "Plan only");
+    deploy->Run = noop;
+    root->AddCommand(deploy);
+
+    auto cluster = Cobalt::CreateCommand();
+    cluster->Use = "cluster";
+    cluster->Short = "Cluster management";
+
+    auto node = Cobalt::CreateCommand();
+    node->Use = "node";
+    node->Short = "Node management";
+
+    auto drain = Cobalt::CreateCommand();
+    drain->Use = "drain [node]";
+    drain->Short = "Drain a node";
+    drain->LocalFlags.Add<int>(g_gracePeriod, "grace-period", "", 0, "Grace period in seconds");
+    drain->Run = noop;
+    node->AddCommand(drain);
+
+    auto list = Cobalt::CreateCommand();
+    list->Use = "list";
+    list->Short = "List nodes";
+    list->Run = noop;
+    node->AddCommand(list);
+
+    cluster->AddCommand(node);
+    root->AddCommand(cluster);
+
+    return root;
+}
+
+// ---------------------------------------------------------------------------
+// Corpus loading
+// ---------------------------------------------------------------------------
+
+static std::vector<Cobalt::Arguments> LoadCorpus(const char* path) {
+    std::vector<Cobalt::Arguments> corpus;
+
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        Cobalt::Arguments argv;
+        std::istringstream tokens(line);
+        std::string token;
+        while (tokens >> token) argv.push_back(token);
+
+        if (!argv.empty()) corpus.push_back(std::move(argv));
+    }
+
+    return corpus;
+}
+
+// ---------------------------------------------------------------------------
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = (size_t)(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "benchmarks/corpus.txt";
+    size_t rounds = argc > 2 ? (size_t)std::atoi(argv[2]) : 200;
+
+    auto corpus = LoadCorpus(path);
+    if (corpus.empty()) {
+        std::fprintf(stderr, "replay: empty or missing corpus: %s\n", path);
+        return 1;
+    }
+
+    auto root = MakeStubTree();
+    root->Compile();
+
+    // Silence the help, usage and suggestion output during the replay;
+    // rendering is part of the measured work, writing it is not.
+    std::ostringstream sink;
+    auto* coutBuffer = std::cout.rdbuf(sink.rdbuf());
+    auto* cerrBuffer = std::cerr.rdbuf(sink.rdbuf());
+
+    std::vector<double> samples;
+    samples.reserve(rounds * corpus.size());
+
+    // Warm up one round so the lazy caches do not dominate the samples
+    for (auto& line : corpus) {
+        root->Execute(static_cast<Cobalt::ArgumentsView>(line));
+    }
+
+    size_t allocsBefore = g_allocations;
+
+    for (size_t round = 0; round < rounds; ++round) {
+        for (auto& line : corpus) {
+            sink.str("");
+
+            auto start = std::chrono::steady_clock::now();
+            root->Execute(static_cast<Cobalt::ArgumentsView>(line));
+            auto stop = std::chrono::steady_clock::now();
+
+            samples.push_back((double)
+                std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        }
+    }
+
+    size_t allocs = g_allocations - allocsBefore;
+
+    std::cout.rdbuf(coutBuffer);
+    std::cerr.rdbuf(cerrBuffer);
+
+    std::sort(samples.begin(), samples.end());
+
+    // One JSON object on one line: stable key order, CI diffs the
+    // allocation figure and trends the percentiles
+    std::printf("{\"corpus\":\"%s\",\"lines\":%zu,\"rounds\":%zu,"
+                "\"p50_ns\":%.0f,\"p95_ns\":%.0f,\"p99_ns\":%.0f,"
+                "\"allocs_per_line\":%.2f}\n",
+                path, corpus.size(), rounds,
+                Percentile(samples, 0.50),
+                Percentile(samples, 0.95),
+                Percentile(samples, 0.99),
+                (double)allocs / samples.size());
+
+    return 0;
+}